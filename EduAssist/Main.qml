@@ -32,6 +32,18 @@ ApplicationWindow {
         id: musicPlayer
     }
 
+    Shortcut {
+        sequences: [StandardKey.Undo]
+        enabled: courseManager.canUndo
+        onActivated: courseManager.undo()
+    }
+
+    Shortcut {
+        sequences: [StandardKey.Redo]
+        enabled: courseManager.canRedo
+        onActivated: courseManager.redo()
+    }
+
     Component.onCompleted: {
         var xhr = new XMLHttpRequest();
         xhr.open("GET", "http://worldclockapi.com/api/json/est/now");
@@ -1,10 +1,21 @@
 #include "CourseManager.h"
 #include <QDebug>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QJsonArray>
 
 CourseManager::CourseManager(QObject *parent)
     : QObject(parent)
     , m_dbManager(new DatabaseManager(this))
+    , m_workload(new WorkloadService(m_dbManager, this))
 {
+    connect(m_dbManager, &DatabaseManager::journalChanged, this, &CourseManager::historyChanged);
+}
+
+CourseManager::~CourseManager()
+{
+    // Робочі задачі звертаються до this, тому чекаємо їх до руйнування
+    m_dbManager->waitForReadTasks();
 }
 
 QVariantList CourseManager::courses() const
@@ -12,6 +23,11 @@ QVariantList CourseManager::courses() const
     return m_courses;
 }
 
+WorkloadService *CourseManager::workload() const
+{
+    return m_workload;
+}
+
 bool CourseManager::initDatabase(const QString &dbPath)
 {
     if (!m_dbManager->initDatabase(dbPath)) {
@@ -26,6 +42,8 @@ bool CourseManager::initDatabase(const QString &dbPath)
 void CourseManager::loadDataFromDatabase()
 {
     m_courses.clear();
+    m_subjectCourse.clear();
+    m_taskSubject.clear();
 
     // Получаем все курсы из БД
     QList<QVariantMap> dbCourses = m_dbManager->getAllCourses();
@@ -48,6 +66,7 @@ void CourseManager::loadDataFromDatabase()
 
             QVariantList tasks;
             int subjectId = dbSubject["id"].toInt();
+            m_subjectCourse.insert(subjectId, courseId);
 
             // Получаем задания для предмета
             QList<QVariantMap> dbAssignments = m_dbManager->getAssignmentsBySubject(subjectId);
@@ -61,6 +80,7 @@ void CourseManager::loadDataFromDatabase()
                 task["date"] = dbAssignment["date"].toString();
                 task["completed"] = dbAssignment["completed"].toBool();
 
+                m_taskSubject.insert(task["id"].toInt(), subjectId);
                 tasks.append(task);
             }
 
@@ -72,6 +92,7 @@ void CourseManager::loadDataFromDatabase()
         m_courses.append(course);
     }
 
+    m_workload->reload();
     emit coursesChanged();
 }
 
@@ -176,6 +197,10 @@ void CourseManager::updateTaskGrade(int courseIndex, int subjectIndex, int taskI
     QVariantList tasks = subject["tasks"].toList();
     QVariantMap task = tasks[taskIndex].toMap();
 
+    // Значення не змінилось (напр. поле просто втратило фокус)
+    if (task["grade"].toString() == grade)
+        return;
+
     QString currentName = task["name"].toString();
     QString currentMaxGrade = task["max_grade"].toString();
     QString currentDate = task["date"].toString();
@@ -189,6 +214,7 @@ void CourseManager::updateTaskGrade(int courseIndex, int subjectIndex, int taskI
         subjects[subjectIndex] = subject;
         course["subjects"] = subjects;
         m_courses[courseIndex] = course;
+        m_workload->flushChanges();
         emit coursesChanged();
     }
 }
@@ -208,12 +234,21 @@ void CourseManager::updateTaskMaxGrade(int courseIndex, int subjectIndex, int ta
     QVariantList tasks = subject["tasks"].toList();
     QVariantMap task = tasks[taskIndex].toMap();
 
+    // Значення не змінилось (напр. поле просто втратило фокус)
+    if (task["max_grade"].toString() == maxGrade)
+        return;
+
     QString currentName = task["name"].toString();
     QString currentGrade = task["grade"].toString();
     QString currentDate = task["date"].toString();
     bool currentCompleted = task["completed"].toBool();
 
     if (m_dbManager->updateAssignment(taskId, currentName, currentGrade, maxGrade, currentDate, currentCompleted)) {
+        if (!currentCompleted) {
+            m_workload->removeOpenTask(currentDate, task["max_grade"].toString());
+            m_workload->addOpenTask(currentDate, maxGrade);
+        }
+
         // Обновляем локально без полной перезагрузки
         task["max_grade"] = maxGrade;
         tasks[taskIndex] = task;
@@ -221,6 +256,7 @@ void CourseManager::updateTaskMaxGrade(int courseIndex, int subjectIndex, int ta
         subjects[subjectIndex] = subject;
         course["subjects"] = subjects;
         m_courses[courseIndex] = course;
+        m_workload->flushChanges();
         emit coursesChanged();
     }
 }
@@ -240,12 +276,21 @@ void CourseManager::updateTaskDate(int courseIndex, int subjectIndex, int taskIn
     QVariantList tasks = subject["tasks"].toList();
     QVariantMap task = tasks[taskIndex].toMap();
 
+    // Значення не змінилось (напр. поле просто втратило фокус)
+    if (task["date"].toString() == date)
+        return;
+
     QString currentName = task["name"].toString();
     QString currentGrade = task["grade"].toString();
     QString currentMaxGrade = task["max_grade"].toString();
     bool currentCompleted = task["completed"].toBool();
 
     if (m_dbManager->updateAssignment(taskId, currentName, currentGrade, currentMaxGrade, date, currentCompleted)) {
+        if (!currentCompleted) {
+            m_workload->removeOpenTask(task["date"].toString(), currentMaxGrade);
+            m_workload->addOpenTask(date, currentMaxGrade);
+        }
+
         // Обновляем локально без полной перезагрузки
         task["date"] = date;
         tasks[taskIndex] = task;
@@ -253,6 +298,7 @@ void CourseManager::updateTaskDate(int courseIndex, int subjectIndex, int taskIn
         subjects[subjectIndex] = subject;
         course["subjects"] = subjects;
         m_courses[courseIndex] = course;
+        m_workload->flushChanges();
         emit coursesChanged();
     }
 }
@@ -272,12 +318,21 @@ void CourseManager::updateTaskCompleted(int courseIndex, int subjectIndex, int t
     QVariantList tasks = subject["tasks"].toList();
     QVariantMap task = tasks[taskIndex].toMap();
 
+    if (task["completed"].toBool() == completed)
+        return;
+
     QString currentName = task["name"].toString();
     QString currentGrade = task["grade"].toString();
     QString currentMaxGrade = task["max_grade"].toString();
     QString currentDate = task["date"].toString();
 
     if (m_dbManager->updateAssignment(taskId, currentName, currentGrade, currentMaxGrade, currentDate, completed)) {
+        if (completed && !task["completed"].toBool()) {
+            m_workload->removeOpenTask(currentDate, currentMaxGrade);
+        } else if (!completed && task["completed"].toBool()) {
+            m_workload->addOpenTask(currentDate, currentMaxGrade);
+        }
+
         // Обновляем локально без полной перезагрузки
         task["completed"] = completed;
         tasks[taskIndex] = task;
@@ -285,6 +340,7 @@ void CourseManager::updateTaskCompleted(int courseIndex, int subjectIndex, int t
         subjects[subjectIndex] = subject;
         course["subjects"] = subjects;
         m_courses[courseIndex] = course;
+        m_workload->flushChanges();
         emit coursesChanged();
     }
 }
@@ -327,3 +383,328 @@ void CourseManager::removeTask(int courseIndex, int subjectIndex, int taskIndex)
         rebuildCoursesFromDatabase();
     }
 }
+
+void CourseManager::setReadThreadCount(int count)
+{
+    m_dbManager->setReadThreadCount(count);
+}
+
+void CourseManager::requestStatistics()
+{
+    // Базові записи по курсах у UI потоці; суми по завданнях рахують робочі потоки
+    QVariantList statistics;
+    QHash<int, int> courseOfSubject;
+    QList<int> subjectIds;
+
+    for (int i = 0; i < m_courses.size(); ++i) {
+        const QVariantMap course = m_courses[i].toMap();
+        const QVariantList subjects = course.value("subjects").toList();
+
+        QVariantMap stats;
+        stats["id"] = course.value("id");
+        stats["name"] = course.value("name");
+        stats["subjects"] = int(subjects.size());
+        stats["tasks"] = 0;
+        stats["completed"] = 0;
+        stats["grade"] = 0.0;
+        stats["max_grade"] = 0.0;
+        statistics.append(stats);
+
+        for (const QVariant &subject : subjects) {
+            const int subjectId = subject.toMap().value("id").toInt();
+            courseOfSubject.insert(subjectId, i);
+            subjectIds.append(subjectId);
+        }
+    }
+
+    if (subjectIds.isEmpty()) {
+        emit statisticsReady(statistics);
+        return;
+    }
+
+    // Предмети діляться по колу на стільки частин, скільки потоків у пулі
+    const int chunkCount = qMin(m_dbManager->readThreadCount(), int(subjectIds.size()));
+    QList<QList<int>> chunks(chunkCount);
+    for (int i = 0; i < subjectIds.size(); ++i) {
+        chunks[i % chunkCount].append(subjectIds[i]);
+    }
+
+    // Кожна задача пише лише у свій слот, останнє завершення збирає результат у UI потоці
+    auto results = QSharedPointer<QList<QList<QVariantMap>>>::create(chunkCount);
+    auto remaining = QSharedPointer<QAtomicInt>::create(chunkCount);
+
+    for (int k = 0; k < chunkCount; ++k) {
+        const QList<int> chunk = chunks[k];
+
+        m_dbManager->runReadTask([this, results, remaining, k, chunk, statistics, courseOfSubject]() {
+            (*results)[k] = m_dbManager->getSubjectStatistics(chunk);
+
+            if (!remaining->deref()) {
+                QMetaObject::invokeMethod(this, [this, results, statistics, courseOfSubject]() mutable {
+                    for (const QList<QVariantMap> &chunkStats : std::as_const(*results)) {
+                        for (const QVariantMap &subjectStats : chunkStats) {
+                            const int courseIndex = courseOfSubject.value(subjectStats["id"].toInt());
+                            QVariantMap stats = statistics[courseIndex].toMap();
+                            stats["tasks"] = stats["tasks"].toInt() + subjectStats["tasks"].toInt();
+                            stats["completed"] = stats["completed"].toInt() + subjectStats["completed"].toInt();
+                            stats["grade"] = stats["grade"].toDouble() + subjectStats["grade"].toDouble();
+                            stats["max_grade"] = stats["max_grade"].toDouble() + subjectStats["max_grade"].toDouble();
+                            statistics[courseIndex] = stats;
+                        }
+                    }
+                    emit statisticsReady(statistics);
+                }, Qt::QueuedConnection);
+            }
+        });
+    }
+}
+
+bool CourseManager::canUndo() const
+{
+    return m_dbManager->canUndo();
+}
+
+bool CourseManager::canRedo() const
+{
+    return m_dbManager->canRedo();
+}
+
+void CourseManager::undo()
+{
+    const QJsonObject action = m_dbManager->undo();
+    if (action.isEmpty()) {
+        qDebug() << "Немає операцій для скасування";
+        return;
+    }
+
+    applyJournalAction(action);
+}
+
+void CourseManager::redo()
+{
+    const QJsonObject action = m_dbManager->redo();
+    if (action.isEmpty()) {
+        qDebug() << "Немає операцій для повторення";
+        return;
+    }
+
+    applyJournalAction(action);
+}
+
+// Списки в дереві впорядковані за ID (ORDER BY id у БД), тому пошук бінарний
+static int lowerBoundById(const QVariantList &list, int id)
+{
+    int low = 0;
+    int high = int(list.size());
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        if (list[mid].toMap().value("id").toInt() < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static int indexOfId(const QVariantList &list, int id)
+{
+    const int position = lowerBoundById(list, id);
+    if (position < list.size() && list[position].toMap().value("id").toInt() == id)
+        return position;
+    return -1;
+}
+
+static QVariantMap taskFromJournalRow(const QJsonObject &row)
+{
+    QVariantMap task;
+    task["id"] = row["id"].toInt();
+    task["name"] = row["name"].toString();
+    task["grade"] = row["grade"].toString();
+    task["max_grade"] = row["max_grade"].toString();
+    task["date"] = row["date"].toString();
+    task["completed"] = row["completed"].toInt() == 1;
+    return task;
+}
+
+int CourseManager::findCourse(int courseId) const
+{
+    return indexOfId(m_courses, courseId);
+}
+
+bool CourseManager::findSubject(int subjectId, int &courseIndex, int &subjectIndex) const
+{
+    courseIndex = findCourse(m_subjectCourse.value(subjectId, -1));
+    if (courseIndex == -1)
+        return false;
+
+    subjectIndex = indexOfId(m_courses[courseIndex].toMap().value("subjects").toList(), subjectId);
+    return subjectIndex != -1;
+}
+
+bool CourseManager::findTask(int taskId, int &courseIndex, int &subjectIndex, int &taskIndex) const
+{
+    if (!findSubject(m_taskSubject.value(taskId, -1), courseIndex, subjectIndex))
+        return false;
+
+    const QVariantList subjects = m_courses[courseIndex].toMap().value("subjects").toList();
+    taskIndex = indexOfId(subjects[subjectIndex].toMap().value("tasks").toList(), taskId);
+    return taskIndex != -1;
+}
+
+void CourseManager::editSubjects(int courseIndex, const std::function<void(QVariantList &)> &edit)
+{
+    // Забираємо вузли з дерева перед зміною, щоб список не копіювався (detach)
+    QVariantMap course = m_courses[courseIndex].toMap();
+    m_courses[courseIndex] = QVariant();
+    QVariantList subjects = course.take("subjects").toList();
+
+    edit(subjects);
+
+    course["subjects"] = subjects;
+    m_courses[courseIndex] = course;
+}
+
+void CourseManager::editTasks(int courseIndex, int subjectIndex, const std::function<void(QVariantList &)> &edit)
+{
+    editSubjects(courseIndex, [subjectIndex, &edit](QVariantList &subjects) {
+        QVariantMap subject = subjects[subjectIndex].toMap();
+        subjects[subjectIndex] = QVariant();
+        QVariantList tasks = subject.take("tasks").toList();
+
+        edit(tasks);
+
+        subject["tasks"] = tasks;
+        subjects[subjectIndex] = subject;
+    });
+}
+
+void CourseManager::forgetTasks(const QVariantList &tasks)
+{
+    for (const QVariant &value : tasks) {
+        const QVariantMap task = value.toMap();
+        m_taskSubject.remove(task["id"].toInt());
+        if (!task["completed"].toBool()) {
+            m_workload->removeOpenTask(task["date"].toString(), task["max_grade"].toString());
+        }
+    }
+}
+
+void CourseManager::applyJournalAction(const QJsonObject &action)
+{
+    const QString type = action["type"].toString();
+
+    if (type == "insert") {
+        for (const QJsonValue &value : action["courses"].toArray()) {
+            const QJsonObject row = value.toObject();
+            QVariantMap course;
+            course["id"] = row["id"].toInt();
+            course["name"] = row["name"].toString();
+            course["subjects"] = QVariantList();
+            m_courses.insert(lowerBoundById(m_courses, row["id"].toInt()), course);
+        }
+
+        // Рядки групуються за батьком, щоб кожен список змінювався один раз
+        QMap<int, QVariantList> subjectsByCourse;
+        for (const QJsonValue &value : action["subjects"].toArray()) {
+            const QJsonObject row = value.toObject();
+            QVariantMap subject;
+            subject["id"] = row["id"].toInt();
+            subject["name"] = row["name"].toString();
+            subject["tasks"] = QVariantList();
+            subjectsByCourse[row["course_id"].toInt()].append(subject);
+            m_subjectCourse.insert(row["id"].toInt(), row["course_id"].toInt());
+        }
+
+        for (auto it = subjectsByCourse.cbegin(); it != subjectsByCourse.cend(); ++it) {
+            const int courseIndex = findCourse(it.key());
+            if (courseIndex == -1)
+                continue;
+
+            editSubjects(courseIndex, [&it](QVariantList &subjects) {
+                for (const QVariant &subject : it.value()) {
+                    subjects.insert(lowerBoundById(subjects, subject.toMap().value("id").toInt()), subject);
+                }
+            });
+        }
+
+        QMap<int, QVariantList> tasksBySubject;
+        for (const QJsonValue &value : action["assignments"].toArray()) {
+            const QJsonObject row = value.toObject();
+            const QVariantMap task = taskFromJournalRow(row);
+            tasksBySubject[row["subject_id"].toInt()].append(task);
+            m_taskSubject.insert(task["id"].toInt(), row["subject_id"].toInt());
+
+            if (!task["completed"].toBool()) {
+                m_workload->addOpenTask(task["date"].toString(), task["max_grade"].toString());
+            }
+        }
+
+        for (auto it = tasksBySubject.cbegin(); it != tasksBySubject.cend(); ++it) {
+            int courseIndex = -1;
+            int subjectIndex = -1;
+            if (!findSubject(it.key(), courseIndex, subjectIndex))
+                continue;
+
+            editTasks(courseIndex, subjectIndex, [&it](QVariantList &tasks) {
+                for (const QVariant &task : it.value()) {
+                    tasks.insert(lowerBoundById(tasks, task.toMap().value("id").toInt()), task);
+                }
+            });
+        }
+    } else if (type == "delete") {
+        const QString table = action["table"].toString();
+        const int id = action["id"].toInt();
+
+        if (table == "courses") {
+            const int courseIndex = findCourse(id);
+            if (courseIndex != -1) {
+                for (const QVariant &subject : m_courses[courseIndex].toMap().value("subjects").toList()) {
+                    m_subjectCourse.remove(subject.toMap().value("id").toInt());
+                    forgetTasks(subject.toMap().value("tasks").toList());
+                }
+                m_courses.removeAt(courseIndex);
+            }
+        } else if (table == "subjects") {
+            int courseIndex = -1;
+            int subjectIndex = -1;
+            if (findSubject(id, courseIndex, subjectIndex)) {
+                editSubjects(courseIndex, [this, subjectIndex](QVariantList &subjects) {
+                    forgetTasks(subjects[subjectIndex].toMap().value("tasks").toList());
+                    subjects.removeAt(subjectIndex);
+                });
+                m_subjectCourse.remove(id);
+            }
+        } else if (table == "assignments") {
+            int courseIndex = -1;
+            int subjectIndex = -1;
+            int taskIndex = -1;
+            if (findTask(id, courseIndex, subjectIndex, taskIndex)) {
+                editTasks(courseIndex, subjectIndex, [this, taskIndex](QVariantList &tasks) {
+                    forgetTasks(QVariantList{tasks[taskIndex]});
+                    tasks.removeAt(taskIndex);
+                });
+            }
+        }
+    } else if (type == "update") {
+        const QVariantMap task = taskFromJournalRow(action["assignment"].toObject());
+        int courseIndex = -1;
+        int subjectIndex = -1;
+        int taskIndex = -1;
+
+        if (findTask(task["id"].toInt(), courseIndex, subjectIndex, taskIndex)) {
+            editTasks(courseIndex, subjectIndex, [this, &task, taskIndex](QVariantList &tasks) {
+                const QVariantMap previous = tasks[taskIndex].toMap();
+                if (!previous["completed"].toBool()) {
+                    m_workload->removeOpenTask(previous["date"].toString(), previous["max_grade"].toString());
+                }
+                if (!task["completed"].toBool()) {
+                    m_workload->addOpenTask(task["date"].toString(), task["max_grade"].toString());
+                }
+                tasks[taskIndex] = task;
+            });
+        }
+    }
+
+    m_workload->flushChanges();
+    emit coursesChanged();
+}
@@ -4,19 +4,29 @@
 #include <QObject>
 #include <QVariantList>
 #include <QVariantMap>
+#include <QJsonObject>
+#include <QHash>
+#include <functional>
 #include "databasemanager.h"
+#include "workloadservice.h"
 
 class CourseManager : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QVariantList courses READ courses NOTIFY coursesChanged)
+    Q_PROPERTY(bool canUndo READ canUndo NOTIFY historyChanged)
+    Q_PROPERTY(bool canRedo READ canRedo NOTIFY historyChanged)
 
 public:
     explicit CourseManager(QObject *parent = nullptr);
+    ~CourseManager();
 
     // Отримати всі курси
     QVariantList courses() const;
 
+    // Навантаження по дедлайнах
+    WorkloadService *workload() const;
+
     // Ініціалізація БД
     Q_INVOKABLE bool initDatabase(const QString &dbPath = "courses.db");
 
@@ -36,13 +46,30 @@ public:
     Q_INVOKABLE void removeSubject(int courseIndex, int subjectIndex);
     Q_INVOKABLE void removeTask(int courseIndex, int subjectIndex, int taskIndex);
 
+    // Скасування / повторення
+    bool canUndo() const;
+    bool canRedo() const;
+    Q_INVOKABLE void undo();
+    Q_INVOKABLE void redo();
+
+    // Статистика по курсах: предмети діляться між потоками пулу читання
+    Q_INVOKABLE void requestStatistics();
+    void setReadThreadCount(int count);
+
 signals:
     void coursesChanged();
+    void historyChanged();
+    void statisticsReady(const QVariantList &statistics);
 
 private:
     QVariantList m_courses;
     DatabaseManager *m_dbManager;
 
+    // ID -> ID батька, щоб знаходити вузли дерева без повного обходу
+    QHash<int, int> m_subjectCourse;
+    QHash<int, int> m_taskSubject;
+    WorkloadService *m_workload;
+
     // Допоміжні методи
     void loadDataFromDatabase();
     void rebuildCoursesFromDatabase();
@@ -51,6 +78,17 @@ private:
     int getCourseIdByIndex(int courseIndex) const;
     int getSubjectIdByIndex(int courseIndex, int subjectIndex) const;
     int getTaskIdByIndex(int courseIndex, int subjectIndex, int taskIndex) const;
+
+    // Пошук індексів за ID (для дій із журналу)
+    int findCourse(int courseId) const;
+    bool findSubject(int subjectId, int &courseIndex, int &subjectIndex) const;
+    bool findTask(int taskId, int &courseIndex, int &subjectIndex, int &taskIndex) const;
+
+    // Інкрементне застосування дії журналу до дерева в пам'яті
+    void applyJournalAction(const QJsonObject &action);
+    void editSubjects(int courseIndex, const std::function<void(QVariantList &)> &edit);
+    void editTasks(int courseIndex, int subjectIndex, const std::function<void(QVariantList &)> &edit);
+    void forgetTasks(const QVariantList &tasks);
 };
 
 #endif // COURSEMANAGER_H
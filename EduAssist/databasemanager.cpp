@@ -1,11 +1,29 @@
 #include "databasemanager.h"
+#include <QThread>
+#include <QDate>
+#include <QJsonDocument>
+#include <QSqlRecord>
+#include <QTimer>
+
+namespace {
+// Скільки останніх операцій зберігається для undo
+const int kJournalDepth = 200;
+// Кожні N записів у журнал запускається фонове стиснення
+const int kJournalCompactEvery = 64;
+}
 
 DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent)
 {
+    m_readPool.setMaxThreadCount(QThread::idealThreadCount());
+    // Потоки пулу не завершуються під час простою, інакше їхні з'єднання
+    // закривались би і відкривались заново при наступному звіті
+    m_readPool.setExpiryTimeout(-1);
 }
 
 DatabaseManager::~DatabaseManager()
 {
+    m_readPool.waitForDone();
+
     if (db.isOpen()) {
         db.close();
     }
@@ -15,6 +33,7 @@ bool DatabaseManager::initDatabase(const QString &dbPath)
 {
     db = QSqlDatabase::addDatabase("QSQLITE");
     db.setDatabaseName(dbPath);
+    m_dbPath = dbPath;
 
     if (!db.open()) {
         qDebug() << "Помилка відкриття БД:" << db.lastError().text();
@@ -34,6 +53,11 @@ bool DatabaseManager::createTables()
         qDebug() << "Помилка включення foreign keys:" << query.lastError().text();
     }
 
+    // WAL: читачі з робочих потоків не чекають на запис з UI
+    if (!query.exec("PRAGMA journal_mode = WAL")) {
+        qDebug() << "Помилка включення WAL:" << query.lastError().text();
+    }
+
     // Таблица курсов
     if (!query.exec("CREATE TABLE IF NOT EXISTS courses ("
                     "id INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -64,7 +88,8 @@ bool DatabaseManager::createTables()
     qDebug() << "Існуючі колонки в assignments:" << columns;
 
     // Если таблица существует, но у неё неправильная структура, пересоздаём её
-    if (columns.size() > 0 && (!columns.contains("name") || !columns.contains("completed") || !columns.contains("max_grade"))) {
+    const bool legacyLayout = columns.size() > 0 && (!columns.contains("name") || !columns.contains("completed") || !columns.contains("max_grade"));
+    if (legacyLayout) {
         qDebug() << "Стара структура таблиці assignments виявлена. Перестворюємо...";
 
         // Удаляем старую таблицу
@@ -82,11 +107,102 @@ bool DatabaseManager::createTables()
                     "max_grade TEXT,"
                     "date TEXT,"
                     "completed INTEGER DEFAULT 0,"
+                    "due_day INTEGER,"
                     "FOREIGN KEY (subject_id) REFERENCES subjects(id) ON DELETE CASCADE)")) {
         qDebug() << "Помилка створення таблиці assignments:" << query.lastError().text();
         return false;
     }
 
+    // Колонка due_day з'явилась пізніше — додаємо та заповнюємо зі старих дат.
+    // Одна транзакція: при збої колонка теж відкочується і міграція повториться
+    if (!columns.isEmpty() && !legacyLayout && !columns.contains("due_day")) {
+        if (!db.transaction()) {
+            qDebug() << "Помилка початку міграції due_day:" << db.lastError().text();
+            return false;
+        }
+
+        if (!query.exec("ALTER TABLE assignments ADD COLUMN due_day INTEGER")) {
+            qDebug() << "Помилка додавання колонки due_day:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+
+        QSqlQuery dates(db);
+        if (!dates.exec("SELECT id, date FROM assignments")) {
+            qDebug() << "Помилка читання дат для due_day:" << dates.lastError().text();
+            db.rollback();
+            return false;
+        }
+
+        QSqlQuery fill(db);
+        fill.prepare("UPDATE assignments SET due_day = ? WHERE id = ?");
+
+        while (dates.next()) {
+            const qint64 dueDay = dueDayFromDate(dates.value(1).toString());
+            fill.addBindValue(dueDay < 0 ? QVariant() : QVariant(dueDay));
+            fill.addBindValue(dates.value(0).toInt());
+            if (!fill.exec()) {
+                qDebug() << "Помилка заповнення due_day:" << fill.lastError().text();
+                db.rollback();
+                return false;
+            }
+        }
+
+        if (!db.commit()) {
+            qDebug() << "Помилка завершення міграції due_day:" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    // Індекс для діапазонних запитів по відкритих завданнях
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_assignments_open_due ON assignments (completed, due_day)")) {
+        qDebug() << "Помилка створення індексу due_day:" << query.lastError().text();
+    }
+
+    // Журнал ранньої версії (з колонкою undone) — лише історія, перестворюємо
+    QSqlQuery journalInfo(db);
+    journalInfo.exec("PRAGMA table_info(journal)");
+    QStringList journalColumns;
+    while (journalInfo.next()) {
+        journalColumns << journalInfo.value(1).toString();
+    }
+
+    if (!journalColumns.isEmpty() && !journalColumns.contains("prev")) {
+        qDebug() << "Стара структура таблиці journal виявлена. Перестворюємо...";
+        if (!query.exec("DROP TABLE IF EXISTS journal") || !query.exec("DROP TABLE IF EXISTS journal_head")) {
+            qDebug() << "Помилка видалення старої таблиці journal:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // Журнал операцій: записи лише додаються. prev — запис, який був головою
+    // на момент запису, тож скасування йде ланцюжком prev, а повторення — до
+    // найновішого нащадка голови. Голова зберігається окремо в journal_head
+    if (!query.exec("CREATE TABLE IF NOT EXISTS journal ("
+                    "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                    "prev INTEGER NOT NULL,"
+                    "undo TEXT NOT NULL,"
+                    "redo TEXT NOT NULL)")) {
+        qDebug() << "Помилка створення таблиці journal:" << query.lastError().text();
+        return false;
+    }
+
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_journal_prev ON journal (prev, id)")) {
+        qDebug() << "Помилка створення індексу journal:" << query.lastError().text();
+    }
+
+    if (!query.exec("CREATE TABLE IF NOT EXISTS journal_head ("
+                    "id INTEGER PRIMARY KEY CHECK (id = 0),"
+                    "head INTEGER NOT NULL)")
+        || !query.exec("INSERT OR IGNORE INTO journal_head (id, head) VALUES (0, 0)")) {
+        qDebug() << "Помилка створення таблиці journal_head:" << query.lastError().text();
+        return false;
+    }
+
+    refreshHistoryState();
+    scheduleJournalCompaction();
+
     qDebug() << "Таблиці успішно створені";
     return true;
 }
@@ -94,12 +210,22 @@ bool DatabaseManager::createTables()
 // КУРСЫ
 bool DatabaseManager::addCourse(const QString &courseName)
 {
+    if (!beginWrite()) {
+        return false;
+    }
+
     QSqlQuery query;
     query.prepare("INSERT INTO courses (name) VALUES (?)");
     query.addBindValue(courseName);
 
     if (!query.exec()) {
         qDebug() << "Помилка додавання курсу:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    const int courseId = query.lastInsertId().toInt();
+    if (!commitJournaled(deleteAction("courses", courseId), snapshotCourse(courseId))) {
         return false;
     }
 
@@ -110,7 +236,8 @@ bool DatabaseManager::addCourse(const QString &courseName)
 QList<QVariantMap> DatabaseManager::getAllCourses()
 {
     QList<QVariantMap> courses;
-    QSqlQuery query("SELECT id, name FROM courses ORDER BY id");
+    QSqlQuery query(connectionForCurrentThread());
+    query.exec("SELECT id, name FROM courses ORDER BY id");
 
     while (query.next()) {
         QVariantMap course;
@@ -124,12 +251,24 @@ QList<QVariantMap> DatabaseManager::getAllCourses()
 
 bool DatabaseManager::deleteCourse(int courseId)
 {
+    if (!beginWrite()) {
+        return false;
+    }
+
+    // Знімок разом із предметами та завданнями, які видалить ON DELETE CASCADE
+    const QJsonObject snapshot = snapshotCourse(courseId);
+
     QSqlQuery query;
     query.prepare("DELETE FROM courses WHERE id = ?");
     query.addBindValue(courseId);
 
     if (!query.exec()) {
         qDebug() << "Помилка видалення курсу:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (!commitJournaled(snapshot, deleteAction("courses", courseId))) {
         return false;
     }
 
@@ -140,6 +279,10 @@ bool DatabaseManager::deleteCourse(int courseId)
 // ПРЕДМЕТЫ
 bool DatabaseManager::addSubject(int courseId, const QString &subjectName)
 {
+    if (!beginWrite()) {
+        return false;
+    }
+
     QSqlQuery query;
     query.prepare("INSERT INTO subjects (course_id, name) VALUES (?, ?)");
     query.addBindValue(courseId);
@@ -147,6 +290,12 @@ bool DatabaseManager::addSubject(int courseId, const QString &subjectName)
 
     if (!query.exec()) {
         qDebug() << "Помилка додавання предмету:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    const int subjectId = query.lastInsertId().toInt();
+    if (!commitJournaled(deleteAction("subjects", subjectId), snapshotSubject(subjectId))) {
         return false;
     }
 
@@ -157,7 +306,7 @@ bool DatabaseManager::addSubject(int courseId, const QString &subjectName)
 QList<QVariantMap> DatabaseManager::getSubjectsByCourse(int courseId)
 {
     QList<QVariantMap> subjects;
-    QSqlQuery query;
+    QSqlQuery query(connectionForCurrentThread());
     query.prepare("SELECT id, name FROM subjects WHERE course_id = ? ORDER BY id");
     query.addBindValue(courseId);
 
@@ -175,12 +324,23 @@ QList<QVariantMap> DatabaseManager::getSubjectsByCourse(int courseId)
 
 bool DatabaseManager::deleteSubject(int subjectId)
 {
+    if (!beginWrite()) {
+        return false;
+    }
+
+    const QJsonObject snapshot = snapshotSubject(subjectId);
+
     QSqlQuery query;
     query.prepare("DELETE FROM subjects WHERE id = ?");
     query.addBindValue(subjectId);
 
     if (!query.exec()) {
         qDebug() << "Помилка видалення предмету:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (!commitJournaled(snapshot, deleteAction("subjects", subjectId))) {
         return false;
     }
 
@@ -194,19 +354,31 @@ bool DatabaseManager::addAssignment(int subjectId, const QString &name, const QS
     QSqlQuery query(db);
 
     // Используем прямой exec с форматированием
-    QString queryStr = QString("INSERT INTO assignments (subject_id, name, grade, max_grade, date, completed) VALUES (%1, '%2', '%3', '%4', '%5', %6)")
+    const qint64 dueDay = dueDayFromDate(date);
+    QString queryStr = QString("INSERT INTO assignments (subject_id, name, grade, max_grade, date, completed, due_day) VALUES (%1, '%2', '%3', '%4', '%5', %6, %7)")
                            .arg(subjectId)
                            .arg(name)
                            .arg(grade)
                            .arg(maxGrade)
                            .arg(date)
-                           .arg(completed ? 1 : 0);
+                           .arg(completed ? 1 : 0)
+                           .arg(dueDay < 0 ? QString("NULL") : QString::number(dueDay));
 
     qDebug() << "Виконуємо запит:" << queryStr;
 
+    if (!beginWrite()) {
+        return false;
+    }
+
     if (!query.exec(queryStr)) {
         qDebug() << "Помилка додавання завдання:" << query.lastError().text();
         qDebug() << "Код помилки:" << query.lastError().nativeErrorCode();
+        db.rollback();
+        return false;
+    }
+
+    const int assignmentId = query.lastInsertId().toInt();
+    if (!commitJournaled(deleteAction("assignments", assignmentId), snapshotAssignment(assignmentId))) {
         return false;
     }
 
@@ -217,7 +389,7 @@ bool DatabaseManager::addAssignment(int subjectId, const QString &name, const QS
 QList<QVariantMap> DatabaseManager::getAssignmentsBySubject(int subjectId)
 {
     QList<QVariantMap> assignments;
-    QSqlQuery query;
+    QSqlQuery query(connectionForCurrentThread());
     query.prepare("SELECT id, name, grade, max_grade, date, completed FROM assignments WHERE subject_id = ? ORDER BY id");
     query.addBindValue(subjectId);
 
@@ -239,17 +411,42 @@ QList<QVariantMap> DatabaseManager::getAssignmentsBySubject(int subjectId)
 
 bool DatabaseManager::updateAssignment(int assignmentId, const QString &name, const QString &grade, const QString &maxGrade, const QString &date, bool completed)
 {
+    if (!beginWrite()) {
+        return false;
+    }
+
+    QJsonObject undoAction;
+    undoAction["type"] = "update";
+    undoAction["assignment"] = snapshotAssignment(assignmentId).value("assignments").toArray().at(0);
+
     QSqlQuery query;
-    query.prepare("UPDATE assignments SET name = ?, grade = ?, max_grade = ?, date = ?, completed = ? WHERE id = ?");
+    const qint64 dueDay = dueDayFromDate(date);
+    query.prepare("UPDATE assignments SET name = ?, grade = ?, max_grade = ?, date = ?, completed = ?, due_day = ? WHERE id = ?");
     query.addBindValue(name);
     query.addBindValue(grade);
     query.addBindValue(maxGrade);
     query.addBindValue(date);
     query.addBindValue(completed ? 1 : 0);
+    query.addBindValue(dueDay < 0 ? QVariant() : QVariant(dueDay));
     query.addBindValue(assignmentId);
 
     if (!query.exec()) {
         qDebug() << "Помилка оновлення завдання:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    QJsonObject redoAction;
+    redoAction["type"] = "update";
+    redoAction["assignment"] = snapshotAssignment(assignmentId).value("assignments").toArray().at(0);
+
+    // Нічого не змінилось (напр. поле втратило фокус) — не пишемо в журнал і не чіпаємо redo
+    if (undoAction == redoAction) {
+        db.rollback();
+        return true;
+    }
+
+    if (!commitJournaled(undoAction, redoAction)) {
         return false;
     }
 
@@ -259,15 +456,515 @@ bool DatabaseManager::updateAssignment(int assignmentId, const QString &name, co
 
 bool DatabaseManager::deleteAssignment(int assignmentId)
 {
+    if (!beginWrite()) {
+        return false;
+    }
+
+    const QJsonObject snapshot = snapshotAssignment(assignmentId);
+
     QSqlQuery query;
     query.prepare("DELETE FROM assignments WHERE id = ?");
     query.addBindValue(assignmentId);
 
     if (!query.exec()) {
         qDebug() << "Помилка видалення завдання:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (!commitJournaled(snapshot, deleteAction("assignments", assignmentId))) {
         return false;
     }
 
     qDebug() << "Завдання видалено, ID:" << assignmentId;
     return true;
 }
+
+// ЖУРНАЛ ОПЕРАЦІЙ
+// Дії зберігаються як JSON:
+//   {"type": "insert", "courses": [...], "subjects": [...], "assignments": [...]}
+//   {"type": "delete", "table": "...", "id": N}
+//   {"type": "update", "assignment": {...}}
+QJsonObject DatabaseManager::undo()
+{
+    if (!beginWrite()) {
+        return QJsonObject();
+    }
+
+    QSqlQuery query;
+    query.prepare("SELECT prev, undo FROM journal WHERE id = ?");
+    query.addBindValue(m_head);
+    if (!query.exec() || !query.next()) {
+        db.rollback();
+        return QJsonObject();
+    }
+
+    const int entryId = m_head;
+    const int prev = query.value(0).toInt();
+    const QJsonObject action = QJsonDocument::fromJson(query.value(1).toByteArray()).object();
+
+    if (!applyAction(action) || !moveHead(prev) || !db.commit()) {
+        qDebug() << "Помилка скасування операції:" << entryId;
+        db.rollback();
+        return QJsonObject();
+    }
+
+    m_head = prev;
+    qDebug() << "Операцію скасовано, ID журналу:" << entryId;
+    setHistoryState(m_undoCount - 1, true);
+    return action;
+}
+
+QJsonObject DatabaseManager::redo()
+{
+    if (!beginWrite()) {
+        return QJsonObject();
+    }
+
+    // Найновіший нащадок голови; старіші нащадки — покинуті гілки
+    QSqlQuery query;
+    query.prepare("SELECT id, redo FROM journal WHERE prev = ? ORDER BY id DESC LIMIT 1");
+    query.addBindValue(m_head);
+    if (!query.exec() || !query.next()) {
+        db.rollback();
+        return QJsonObject();
+    }
+
+    const int entryId = query.value(0).toInt();
+    const QJsonObject action = QJsonDocument::fromJson(query.value(1).toByteArray()).object();
+
+    if (!applyAction(action) || !moveHead(entryId) || !db.commit()) {
+        qDebug() << "Помилка повторення операції:" << entryId;
+        db.rollback();
+        return QJsonObject();
+    }
+
+    m_head = entryId;
+    qDebug() << "Операцію повторено, ID журналу:" << entryId;
+    setHistoryState(m_undoCount + 1, hasRedo());
+    return action;
+}
+
+bool DatabaseManager::canUndo() const
+{
+    return m_undoCount > 0;
+}
+
+bool DatabaseManager::canRedo() const
+{
+    return m_canRedo;
+}
+
+bool DatabaseManager::beginWrite()
+{
+    // IMMEDIATE бере блокування запису одразу, тому читання знімка перед записом
+    // не може застаріти і завершитись SQLITE_BUSY_SNAPSHOT
+    QSqlQuery query(db);
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        qDebug() << "Помилка початку транзакції:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool DatabaseManager::moveHead(int entryId)
+{
+    QSqlQuery query(db);
+    query.prepare("UPDATE journal_head SET head = ? WHERE id = 0");
+    query.addBindValue(entryId);
+
+    if (!query.exec()) {
+        qDebug() << "Помилка оновлення голови журналу:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool DatabaseManager::hasRedo()
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT EXISTS (SELECT 1 FROM journal WHERE prev = ?)");
+    query.addBindValue(m_head);
+    return query.exec() && query.next() && query.value(0).toBool();
+}
+
+void DatabaseManager::refreshHistoryState()
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT head FROM journal_head WHERE id = 0") || !query.next()) {
+        qDebug() << "Помилка читання голови журналу:" << query.lastError().text();
+        return;
+    }
+    m_head = query.value(0).toInt();
+
+    // Глибина undo — довжина ланцюжка prev від голови до першого стиснутого запису
+    query.prepare("WITH RECURSIVE chain(id, prev) AS ("
+                  "SELECT id, prev FROM journal WHERE id = ? "
+                  "UNION ALL SELECT j.id, j.prev FROM journal j JOIN chain c ON j.id = c.prev) "
+                  "SELECT COUNT(*) FROM chain");
+    query.addBindValue(m_head);
+    if (!query.exec() || !query.next()) {
+        qDebug() << "Помилка підрахунку журналу:" << query.lastError().text();
+        return;
+    }
+
+    setHistoryState(query.value(0).toInt(), hasRedo());
+}
+
+void DatabaseManager::setHistoryState(int undoCount, bool canRedo)
+{
+    const bool changed = (undoCount > 0) != (m_undoCount > 0) || canRedo != m_canRedo;
+    m_undoCount = undoCount;
+    m_canRedo = canRedo;
+
+    if (changed) {
+        emit journalChanged();
+    }
+}
+
+bool DatabaseManager::commitJournaled(const QJsonObject &undoAction, const QJsonObject &redoAction)
+{
+    // Гілка redo не видаляється: новий запис просто стає найновішим нащадком
+    // поточної голови, а стару гілку згодом прибере стиснення
+    QSqlQuery query;
+    query.prepare("INSERT INTO journal (prev, undo, redo) VALUES (?, ?, ?)");
+    query.addBindValue(m_head);
+    query.addBindValue(QString::fromUtf8(QJsonDocument(undoAction).toJson(QJsonDocument::Compact)));
+    query.addBindValue(QString::fromUtf8(QJsonDocument(redoAction).toJson(QJsonDocument::Compact)));
+
+    if (!query.exec()) {
+        qDebug() << "Помилка запису в журнал:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    const int entryId = query.lastInsertId().toInt();
+    if (!moveHead(entryId) || !db.commit()) {
+        qDebug() << "Помилка запису в журнал:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    m_head = entryId;
+
+    if (++m_journalAppends % kJournalCompactEvery == 0) {
+        scheduleJournalCompaction();
+    }
+
+    setHistoryState(m_undoCount + 1, false);
+    return true;
+}
+
+bool DatabaseManager::applyAction(const QJsonObject &action)
+{
+    const QString type = action["type"].toString();
+    QSqlQuery query;
+
+    if (type == "insert") {
+        // Порядок важливий: батьківські записи раніше за дочірні
+        for (const QJsonValue &value : action["courses"].toArray()) {
+            const QJsonObject row = value.toObject();
+            query.prepare("INSERT INTO courses (id, name) VALUES (?, ?)");
+            query.addBindValue(row["id"].toInt());
+            query.addBindValue(row["name"].toString());
+            if (!query.exec()) {
+                qDebug() << "Помилка відновлення курсу:" << query.lastError().text();
+                return false;
+            }
+        }
+
+        for (const QJsonValue &value : action["subjects"].toArray()) {
+            const QJsonObject row = value.toObject();
+            query.prepare("INSERT INTO subjects (id, course_id, name) VALUES (?, ?, ?)");
+            query.addBindValue(row["id"].toInt());
+            query.addBindValue(row["course_id"].toInt());
+            query.addBindValue(row["name"].toString());
+            if (!query.exec()) {
+                qDebug() << "Помилка відновлення предмету:" << query.lastError().text();
+                return false;
+            }
+        }
+
+        for (const QJsonValue &value : action["assignments"].toArray()) {
+            const QJsonObject row = value.toObject();
+            const qint64 dueDay = dueDayFromDate(row["date"].toString());
+            query.prepare("INSERT INTO assignments (id, subject_id, name, grade, max_grade, date, completed, due_day) "
+                          "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+            query.addBindValue(row["id"].toInt());
+            query.addBindValue(row["subject_id"].toInt());
+            query.addBindValue(row["name"].toString());
+            query.addBindValue(row["grade"].toString());
+            query.addBindValue(row["max_grade"].toString());
+            query.addBindValue(row["date"].toString());
+            query.addBindValue(row["completed"].toInt());
+            query.addBindValue(dueDay < 0 ? QVariant() : QVariant(dueDay));
+            if (!query.exec()) {
+                qDebug() << "Помилка відновлення завдання:" << query.lastError().text();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    if (type == "delete") {
+        const QString table = action["table"].toString();
+        if (table != "courses" && table != "subjects" && table != "assignments") {
+            qDebug() << "Невідома таблиця в журналі:" << table;
+            return false;
+        }
+
+        query.prepare(QString("DELETE FROM %1 WHERE id = ?").arg(table));
+        query.addBindValue(action["id"].toInt());
+        if (!query.exec()) {
+            qDebug() << "Помилка видалення з журналу:" << query.lastError().text();
+            return false;
+        }
+        return true;
+    }
+
+    if (type == "update") {
+        const QJsonObject row = action["assignment"].toObject();
+        const qint64 dueDay = dueDayFromDate(row["date"].toString());
+        query.prepare("UPDATE assignments SET name = ?, grade = ?, max_grade = ?, date = ?, completed = ?, due_day = ? WHERE id = ?");
+        query.addBindValue(row["name"].toString());
+        query.addBindValue(row["grade"].toString());
+        query.addBindValue(row["max_grade"].toString());
+        query.addBindValue(row["date"].toString());
+        query.addBindValue(row["completed"].toInt());
+        query.addBindValue(dueDay < 0 ? QVariant() : QVariant(dueDay));
+        query.addBindValue(row["id"].toInt());
+        if (!query.exec()) {
+            qDebug() << "Помилка оновлення з журналу:" << query.lastError().text();
+            return false;
+        }
+        return true;
+    }
+
+    qDebug() << "Невідомий тип дії в журналі:" << type;
+    return false;
+}
+
+QJsonArray DatabaseManager::selectRows(const QString &sql, int id)
+{
+    QJsonArray rows;
+    QSqlQuery query;
+    query.prepare(sql);
+    query.addBindValue(id);
+
+    if (!query.exec()) {
+        qDebug() << "Помилка знімка для журналу:" << query.lastError().text();
+        return rows;
+    }
+
+    while (query.next()) {
+        const QSqlRecord record = query.record();
+        QJsonObject row;
+        for (int i = 0; i < record.count(); ++i) {
+            row[record.fieldName(i)] = QJsonValue::fromVariant(query.value(i));
+        }
+        rows.append(row);
+    }
+
+    return rows;
+}
+
+QJsonObject DatabaseManager::snapshotCourse(int courseId)
+{
+    QJsonObject action;
+    action["type"] = "insert";
+    action["courses"] = selectRows("SELECT id, name FROM courses WHERE id = ?", courseId);
+    action["subjects"] = selectRows("SELECT id, course_id, name FROM subjects WHERE course_id = ? ORDER BY id", courseId);
+    action["assignments"] = selectRows("SELECT id, subject_id, name, grade, max_grade, date, completed FROM assignments "
+                                       "WHERE subject_id IN (SELECT id FROM subjects WHERE course_id = ?) ORDER BY id", courseId);
+    return action;
+}
+
+QJsonObject DatabaseManager::snapshotSubject(int subjectId)
+{
+    QJsonObject action;
+    action["type"] = "insert";
+    action["subjects"] = selectRows("SELECT id, course_id, name FROM subjects WHERE id = ?", subjectId);
+    action["assignments"] = selectRows("SELECT id, subject_id, name, grade, max_grade, date, completed FROM assignments "
+                                       "WHERE subject_id = ? ORDER BY id", subjectId);
+    return action;
+}
+
+QJsonObject DatabaseManager::snapshotAssignment(int assignmentId)
+{
+    QJsonObject action;
+    action["type"] = "insert";
+    action["assignments"] = selectRows("SELECT id, subject_id, name, grade, max_grade, date, completed FROM assignments "
+                                       "WHERE id = ?", assignmentId);
+    return action;
+}
+
+QJsonObject DatabaseManager::deleteAction(const QString &table, int id)
+{
+    QJsonObject action;
+    action["type"] = "delete";
+    action["table"] = table;
+    action["id"] = id;
+    return action;
+}
+
+void DatabaseManager::scheduleJournalCompaction()
+{
+    if (m_compactionScheduled) {
+        return;
+    }
+
+    // Стискаємо на основному з'єднанні, коли UI потік вільний: другий
+    // записувач конкурував би з правками користувача за блокування
+    m_compactionScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_compactionScheduled = false;
+        compactJournal();
+    });
+}
+
+void DatabaseManager::compactJournal()
+{
+    // Залишаємо останні kJournalDepth предків голови. Нащадки голови (гілка redo)
+    // завжди мають більші ID, тому умова id <= голова їх не зачіпає; решта
+    // записів із меншими ID — глибока історія або покинуті гілки
+    QSqlQuery query(db);
+    query.prepare("WITH RECURSIVE chain(id, prev, depth) AS ("
+                  "SELECT id, prev, 1 FROM journal WHERE id = ? "
+                  "UNION ALL SELECT j.id, j.prev, c.depth + 1 FROM journal j JOIN chain c ON j.id = c.prev "
+                  "WHERE c.depth < ?) "
+                  "DELETE FROM journal WHERE id <= ? AND id NOT IN (SELECT id FROM chain)");
+    query.addBindValue(m_head);
+    query.addBindValue(kJournalDepth);
+    query.addBindValue(m_head);
+
+    if (!query.exec()) {
+        qDebug() << "Помилка стиснення журналу:" << query.lastError().text();
+        return;
+    }
+
+    refreshHistoryState();
+}
+
+// НАВАНТАЖЕННЯ
+qint64 DatabaseManager::dueDayFromDate(const QString &date)
+{
+    // Формат як у parseDate з Main.qml: день.місяць.рік
+    const QDate parsed = QDate::fromString(date.trimmed(), "d.M.yyyy");
+    return parsed.isValid() ? parsed.toJulianDay() : -1;
+}
+
+QList<QVariantMap> DatabaseManager::getOpenWorkload(qint64 fromDay, qint64 toDay)
+{
+    QList<QVariantMap> buckets;
+    QSqlQuery query(connectionForCurrentThread());
+    query.prepare("SELECT due_day, max_grade, COUNT(*) FROM assignments "
+                  "WHERE completed = 0 AND due_day BETWEEN ? AND ? "
+                  "GROUP BY due_day, max_grade ORDER BY due_day");
+    query.addBindValue(fromDay);
+    query.addBindValue(toDay);
+
+    if (!query.exec()) {
+        qDebug() << "Помилка підрахунку навантаження:" << query.lastError().text();
+        return buckets;
+    }
+
+    while (query.next()) {
+        QVariantMap bucket;
+        bucket["due_day"] = query.value(0).toLongLong();
+        bucket["max_grade"] = query.value(1).toString();
+        bucket["count"] = query.value(2).toInt();
+        buckets.append(bucket);
+    }
+
+    return buckets;
+}
+
+// ПАРАЛЕЛЬНЕ ЧИТАННЯ
+QSqlDatabase DatabaseManager::connectionForCurrentThread()
+{
+    if (QThread::currentThread() == thread()) {
+        return db;
+    }
+
+    if (!m_readConnections.hasLocalData()) {
+        const QString name = QString("EduAssist_read_%1").arg(quintptr(QThread::currentThreadId()));
+
+        bool opened = false;
+        {
+            QSqlDatabase readDb = QSqlDatabase::addDatabase("QSQLITE", name);
+            readDb.setDatabaseName(m_dbPath);
+            readDb.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+
+            opened = readDb.open();
+            if (!opened) {
+                qDebug() << "Помилка відкриття з'єднання для читання:" << readDb.lastError().text();
+            }
+        }
+
+        // Невдале з'єднання не кешуємо — наступна задача спробує знову
+        if (!opened) {
+            QSqlDatabase::removeDatabase(name);
+            return QSqlDatabase();
+        }
+
+        m_readConnections.setLocalData(new ReadConnection{name});
+    }
+
+    return QSqlDatabase::database(m_readConnections.localData()->name, false);
+}
+
+void DatabaseManager::runReadTask(const std::function<void()> &task)
+{
+    m_readPool.start(task);
+}
+
+void DatabaseManager::waitForReadTasks()
+{
+    m_readPool.waitForDone();
+}
+
+int DatabaseManager::readThreadCount() const
+{
+    return m_readPool.maxThreadCount();
+}
+
+void DatabaseManager::setReadThreadCount(int count)
+{
+    m_readPool.setMaxThreadCount(qMax(1, count));
+}
+
+QList<QVariantMap> DatabaseManager::getSubjectStatistics(const QList<int> &subjectIds)
+{
+    QList<QVariantMap> statistics;
+    if (subjectIds.isEmpty()) {
+        return statistics;
+    }
+
+    QStringList ids;
+    for (int subjectId : subjectIds) {
+        ids << QString::number(subjectId);
+    }
+
+    QSqlQuery query(connectionForCurrentThread());
+    if (!query.exec(QString("SELECT subject_id, COUNT(*), COALESCE(SUM(completed), 0), "
+                            "COALESCE(SUM(CAST(grade AS REAL)), 0), COALESCE(SUM(CAST(max_grade AS REAL)), 0) "
+                            "FROM assignments WHERE subject_id IN (%1) GROUP BY subject_id").arg(ids.join(',')))) {
+        qDebug() << "Помилка підрахунку статистики предметів:" << query.lastError().text();
+        return statistics;
+    }
+
+    while (query.next()) {
+        QVariantMap stats;
+        stats["id"] = query.value(0).toInt();
+        stats["tasks"] = query.value(1).toInt();
+        stats["completed"] = query.value(2).toInt();
+        stats["grade"] = query.value(3).toDouble();
+        stats["max_grade"] = query.value(4).toDouble();
+        statistics.append(stats);
+    }
+
+    return statistics;
+}
@@ -8,6 +8,11 @@
 #include <QDebug>
 #include <QVariantMap>
 #include <QList>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <functional>
 
 class DatabaseManager : public QObject
 {
@@ -34,9 +39,66 @@ public:
     bool updateAssignment(int assignmentId, const QString &name, const QString &grade, const QString &maxGrade, const QString &date, bool completed);
     bool deleteAssignment(int assignmentId);
 
+    // Навантаження: дата здачі кодується як юліанський день (due_day)
+    static qint64 dueDayFromDate(const QString &date);
+    QList<QVariantMap> getOpenWorkload(qint64 fromDay, qint64 toDay);
+
+    // Журнал операцій (undo/redo)
+    // Повертає застосовану дію, щоб дерево в пам'яті оновилось інкрементно;
+    // порожній об'єкт — нічого не застосовано
+    QJsonObject undo();
+    QJsonObject redo();
+    bool canUndo() const;
+    bool canRedo() const;
+
+    // Паралельне читання
+    // Головний потік пише через основне з'єднання, кожен робочий потік
+    // отримує власне read-only з'єднання (WAL не блокує читачів записом)
+    QSqlDatabase connectionForCurrentThread();
+    void runReadTask(const std::function<void()> &task);
+    void waitForReadTasks();
+    int readThreadCount() const;
+    void setReadThreadCount(int count);
+    QList<QVariantMap> getSubjectStatistics(const QList<int> &subjectIds);
+
+signals:
+    void journalChanged();
+
 private:
+    // З'єднання робочого потоку, видаляється разом із потоком
+    struct ReadConnection {
+        QString name;
+        ~ReadConnection() { QSqlDatabase::removeDatabase(name); }
+    };
+
     QSqlDatabase db;
+    QString m_dbPath;
+    QThreadStorage<ReadConnection *> m_readConnections;
+    QThreadPool m_readPool;
     bool createTables();
+
+    // Журнал: зміна та її обернена дія комітяться однією транзакцією
+    bool beginWrite();
+    bool commitJournaled(const QJsonObject &undoAction, const QJsonObject &redoAction);
+    bool applyAction(const QJsonObject &action);
+    QJsonArray selectRows(const QString &sql, int id);
+    QJsonObject snapshotCourse(int courseId);
+    QJsonObject snapshotSubject(int subjectId);
+    QJsonObject snapshotAssignment(int assignmentId);
+    static QJsonObject deleteAction(const QString &table, int id);
+    void scheduleJournalCompaction();
+    void compactJournal();
+    bool moveHead(int entryId);
+    bool hasRedo();
+    void refreshHistoryState();
+    void setHistoryState(int undoCount, bool canRedo);
+
+    int m_journalAppends = 0;
+    bool m_compactionScheduled = false;
+    // Голова журналу та кеш для canUndo/canRedo, щоб QML-прив'язки не ходили в БД
+    int m_head = 0;
+    int m_undoCount = 0;
+    bool m_canRedo = false;
 };
 
 #endif // DATABASEMANAGER_H
@@ -26,6 +26,7 @@ int main(int argc, char *argv[])
 
     // Реєструємо courseManager в QML
     engine.rootContext()->setContextProperty("courseManager", &courseManager);
+    engine.rootContext()->setContextProperty("workload", courseManager.workload());
 
     QObject::connect(
         &engine,
@@ -0,0 +1,495 @@
+// Навантажувальний стенд для CourseManager без GUI.
+// Відтворює потік викликів, які генерує ContentList.qml (перемикання чекбоксів,
+// правки оцінок і дат, втрата фокусу без змін, додавання/видалення завдань,
+// предметів і курсів, undo/redo), і міряє затримку кожної операції, кількість
+// coursesChanged, алокації та ріст файлу БД.
+//
+// Приклади:
+//   eduassist_stress --tasks 5000 --ops 20000 --rate 50
+//   eduassist_stress --seed 7 --record burst.ops
+//   eduassist_stress --seed 7 --replay burst.ops
+//   eduassist_stress --tasks 200000 --subjects 50 --ops 0 --scale
+//
+// Записаний потік посилається на індекси, тому відтворювати його треба з тими
+// самими --tasks і на свіжій БД (стенд видаляє її перед запуском).
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDate>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "coursemanager.h"
+
+// Лічильник алокацій: глобальні operator new/delete замінено лише в цьому бінарнику.
+// Рахується окремо для кожного потоку, щоб робота пулу читання (операція
+// statistics) не потрапляла в статистику головного потоку
+static thread_local quint64 t_allocations = 0;
+
+void *operator new(std::size_t size)
+{
+    ++t_allocations;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+
+struct OpStats {
+    QList<qint64> latenciesNs;
+    quint64 emissions = 0;
+    quint64 allocations = 0;
+};
+
+bool g_verbose = false;
+
+void quietMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    // qDebug з DatabaseManager на кожну операцію засмічує вивід
+    if (type == QtDebugMsg && !g_verbose)
+        return;
+
+    QTextStream(stderr) << qFormatLogMessage(type, context, message) << Qt::endl;
+}
+
+qint64 databaseSize(const QString &dbPath)
+{
+    return QFileInfo(dbPath).size() + QFileInfo(dbPath + "-wal").size();
+}
+
+void removeDatabaseFiles(const QString &dbPath)
+{
+    QFile::remove(dbPath);
+    QFile::remove(dbPath + "-wal");
+    QFile::remove(dbPath + "-shm");
+}
+
+// Початкове наповнення: 5 курсів, завдання рівномірно між предметами
+void populate(CourseManager &manager, int taskCount, int subjectsPerCourse)
+{
+    const int courseCount = 5;
+
+    for (int c = 0; c < courseCount; ++c) {
+        manager.addCourse(QString("Курс %1").arg(c + 1));
+        for (int s = 0; s < subjectsPerCourse; ++s) {
+            manager.addSubject(c, QString("Предмет %1.%2").arg(c + 1).arg(s + 1));
+        }
+    }
+
+    for (int i = 0; i < taskCount; ++i) {
+        const int c = i % courseCount;
+        const int s = (i / courseCount) % subjectsPerCourse;
+        manager.addTask(c, s, QString("Завдання %1").arg(i + 1));
+    }
+}
+
+// Випадковий предмет з поточного дерева; false якщо предметів немає
+bool pickSubject(const CourseManager &manager, QRandomGenerator &rng, int &c, int &s)
+{
+    const QVariantList courses = manager.courses();
+    if (courses.isEmpty())
+        return false;
+
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        c = rng.bounded(int(courses.size()));
+        const QVariantList subjects = courses[c].toMap()["subjects"].toList();
+        if (subjects.isEmpty())
+            continue;
+
+        s = rng.bounded(int(subjects.size()));
+        return true;
+    }
+
+    return false;
+}
+
+// Випадкове завдання з поточного дерева; false якщо завдань немає
+bool pickTask(const CourseManager &manager, QRandomGenerator &rng, int &c, int &s, int &t, QVariantMap *task = nullptr)
+{
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        if (!pickSubject(manager, rng, c, s))
+            return false;
+
+        const QVariantList tasks = manager.courses()[c].toMap()["subjects"].toList()[s].toMap()["tasks"].toList();
+        if (tasks.isEmpty())
+            continue;
+
+        t = rng.bounded(int(tasks.size()));
+        if (task)
+            *task = tasks[t].toMap();
+        return true;
+    }
+
+    return false;
+}
+
+// Додавання на найглибшому доступному рівні, щоб дерево не спорожніло
+QStringList nextAddOp(const CourseManager &manager, QRandomGenerator &rng)
+{
+    int c = 0;
+    int s = 0;
+    if (pickSubject(manager, rng, c, s))
+        return {"addTask", QString::number(c), QString::number(s), QString("Нове %1").arg(rng.bounded(100000))};
+
+    const int courseCount = int(manager.courses().size());
+    if (courseCount > 0)
+        return {"addSubject", QString::number(rng.bounded(courseCount)), QString("Предмет %1").arg(rng.bounded(100000))};
+
+    return {"addCourse", QString("Курс %1").arg(rng.bounded(100000))};
+}
+
+// Наступна синтетична операція. Поля оцінки, макс. оцінки та дати в ContentList.qml
+// викликають CourseManager з onEditingFinished: один виклик на правку, а також
+// виклик із тим самим значенням при кожній втраті фокусу. Такі виклики йдуть під
+// окремим ключем gradeNoop, щоб не розмивати статистику справжніх правок.
+// Частки в проміле:
+//   300 чекбокс, 250 оцінка, 50 втрата фокусу без змін, 100 макс. оцінка, 100 дата,
+//   80 додати завдання, 50 видалити завдання, 10 видалити предмет, 5 видалити курс,
+//   15 додати предмет, 10 додати курс, 20 undo, 5 redo, 5 статистика
+QStringList nextSyntheticOp(const CourseManager &manager, QRandomGenerator &rng)
+{
+    const int roll = rng.bounded(1000);
+    int c = 0;
+    int s = 0;
+    int t = 0;
+    QVariantMap task;
+
+    // Правки існуючого завдання
+    if (roll < 800) {
+        if (!pickTask(manager, rng, c, s, t, &task))
+            return nextAddOp(manager, rng);
+
+        const QString cs = QString::number(c);
+        const QString ss = QString::number(s);
+        const QString ts = QString::number(t);
+
+        if (roll < 300)
+            return {"completed", cs, ss, ts, task["completed"].toBool() ? "0" : "1"};
+        if (roll < 550)
+            return {"grade", cs, ss, ts, QString::number(rng.bounded(1, 101))};
+        if (roll < 600)
+            return {"gradeNoop", cs, ss, ts, task["grade"].toString()};
+        if (roll < 700)
+            return {"maxGrade", cs, ss, ts, QString::number(rng.bounded(1, 11) * 10)};
+        return {"date", cs, ss, ts, QDate::currentDate().addDays(rng.bounded(120)).toString("dd.MM.yyyy")};
+    }
+
+    if (roll < 880)
+        return nextAddOp(manager, rng);
+    if (roll < 930) {
+        if (!pickTask(manager, rng, c, s, t))
+            return nextAddOp(manager, rng);
+        return {"removeTask", QString::number(c), QString::number(s), QString::number(t)};
+    }
+    if (roll < 940) {
+        if (!pickSubject(manager, rng, c, s))
+            return nextAddOp(manager, rng);
+        return {"removeSubject", QString::number(c), QString::number(s)};
+    }
+    if (roll < 945) {
+        const int courseCount = int(manager.courses().size());
+        // Останній курс не видаляємо, інакше потік вироджується в додавання
+        if (courseCount < 2)
+            return nextAddOp(manager, rng);
+        return {"removeCourse", QString::number(rng.bounded(courseCount))};
+    }
+    if (roll < 960) {
+        const int courseCount = int(manager.courses().size());
+        if (courseCount == 0)
+            return nextAddOp(manager, rng);
+        return {"addSubject", QString::number(rng.bounded(courseCount)), QString("Предмет %1").arg(rng.bounded(100000))};
+    }
+    if (roll < 970)
+        return {"addCourse", QString("Курс %1").arg(rng.bounded(100000))};
+    if (roll < 990)
+        return {"undo"};
+    if (roll < 995)
+        return {"redo"};
+    return {"statistics"};
+}
+
+// Звіт у пулі читання; чекаємо statisticsReady, як чекав би UI
+void runStatistics(CourseManager &manager)
+{
+    bool ready = false;
+    QEventLoop loop;
+    const QMetaObject::Connection connection = QObject::connect(&manager, &CourseManager::statisticsReady,
+                                                                &loop, [&ready, &loop]() {
+        ready = true;
+        loop.quit();
+    });
+
+    manager.requestStatistics();
+    if (!ready)
+        loop.exec();
+
+    QObject::disconnect(connection);
+}
+
+bool runOp(CourseManager &manager, const QStringList &op)
+{
+    const QString name = op.value(0);
+    auto arg = [&op](int i) { return op.value(i).toInt(); };
+
+    if (name == "addCourse")
+        manager.addCourse(op.value(1));
+    else if (name == "addSubject")
+        manager.addSubject(arg(1), op.value(2));
+    else if (name == "addTask")
+        manager.addTask(arg(1), arg(2), op.value(3));
+    else if (name == "grade" || name == "gradeNoop")
+        manager.updateTaskGrade(arg(1), arg(2), arg(3), op.value(4));
+    else if (name == "maxGrade")
+        manager.updateTaskMaxGrade(arg(1), arg(2), arg(3), op.value(4));
+    else if (name == "date")
+        manager.updateTaskDate(arg(1), arg(2), arg(3), op.value(4));
+    else if (name == "completed")
+        manager.updateTaskCompleted(arg(1), arg(2), arg(3), arg(4) != 0);
+    else if (name == "removeTask")
+        manager.removeTask(arg(1), arg(2), arg(3));
+    else if (name == "removeSubject")
+        manager.removeSubject(arg(1), arg(2));
+    else if (name == "removeCourse")
+        manager.removeCourse(arg(1));
+    else if (name == "undo")
+        manager.undo();
+    else if (name == "redo")
+        manager.redo();
+    else if (name == "statistics")
+        runStatistics(manager);
+    else
+        return false;
+
+    return true;
+}
+
+double percentileMs(const QList<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty())
+        return 0.0;
+    const qsizetype index = qMin(sorted.size() - 1, qsizetype(p * sorted.size()));
+    return sorted[index] / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("eduassist_stress");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Навантажувальний стенд для CourseManager");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"db", "Файл БД (видаляється перед запуском).", "path", "stress.db"},
+        {"tasks", "Кількість завдань у початковому наповненні.", "count", "2000"},
+        {"ops", "Кількість синтетичних операцій.", "count", "10000"},
+        {"rate", "Операцій за секунду, 0 — без обмеження.", "ops", "0"},
+        {"seed", "Зерно генератора.", "seed", "1"},
+        {"replay", "Відтворити записаний потік замість синтетичного.", "file"},
+        {"record", "Записати виконаний потік у файл.", "file"},
+        {"subjects", "Предметів на курс у початковому наповненні.", "count", "4"},
+        {"scale", "Після прогону заміряти статистику на 1..N потоках пулу читання."},
+        {"verbose", "Не приховувати qDebug."},
+    });
+    parser.process(app);
+
+    g_verbose = parser.isSet("verbose");
+    qInstallMessageHandler(quietMessageHandler);
+
+    const QString dbPath = parser.value("db");
+    const int taskCount = parser.value("tasks").toInt();
+    const int opCount = parser.value("ops").toInt();
+    const double rate = parser.value("rate").toDouble();
+    QRandomGenerator rng(parser.value("seed").toUInt());
+
+    QTextStream out(stdout);
+
+    // Потік для відтворення: по операції на рядок, поля через табуляцію
+    QList<QStringList> replayOps;
+    if (parser.isSet("replay")) {
+        QFile file(parser.value("replay"));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qCritical() << "Не вдалося відкрити потік:" << file.fileName();
+            return 1;
+        }
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            const QString line = in.readLine();
+            if (!line.isEmpty())
+                replayOps.append(line.split('\t'));
+        }
+    }
+
+    QFile recordFile;
+    QTextStream record;
+    if (parser.isSet("record")) {
+        recordFile.setFileName(parser.value("record"));
+        if (!recordFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            qCritical() << "Не вдалося створити файл запису:" << recordFile.fileName();
+            return 1;
+        }
+        record.setDevice(&recordFile);
+    }
+
+    removeDatabaseFiles(dbPath);
+
+    CourseManager manager;
+    quint64 emissions = 0;
+    QObject::connect(&manager, &CourseManager::coursesChanged, [&emissions]() { ++emissions; });
+
+    if (!manager.initDatabase(dbPath)) {
+        qCritical() << "Не вдалося ініціалізувати БД:" << dbPath;
+        return 1;
+    }
+
+    QElapsedTimer populateTimer;
+    populateTimer.start();
+    populate(manager, taskCount, qMax(1, parser.value("subjects").toInt()));
+    out << "Наповнення: " << taskCount << " завдань за " << populateTimer.elapsed() << " мс" << Qt::endl;
+
+    const qint64 sizeBefore = databaseSize(dbPath);
+    const int totalOps = replayOps.isEmpty() ? opCount : int(replayOps.size());
+
+    QMap<QString, OpStats> stats;
+    QElapsedTimer clock;
+    clock.start();
+
+    for (int i = 0; i < totalOps; ++i) {
+        // Рівномірний темп: чекаємо до запланованого часу операції
+        if (rate > 0) {
+            const qint64 dueNs = qint64(i * 1e9 / rate);
+            const qint64 waitNs = dueNs - clock.nsecsElapsed();
+            if (waitNs > 0)
+                QThread::usleep(quint64(waitNs / 1000));
+        }
+
+        const QStringList op = replayOps.isEmpty() ? nextSyntheticOp(manager, rng) : replayOps[i];
+
+        const quint64 emissionsBefore = emissions;
+        const quint64 allocationsBefore = t_allocations;
+        QElapsedTimer timer;
+        timer.start();
+
+        if (!runOp(manager, op)) {
+            qWarning() << "Невідома операція:" << op;
+            continue;
+        }
+
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        OpStats &opStats = stats[op.value(0)];
+        opStats.latenciesNs.append(elapsedNs);
+        opStats.emissions += emissions - emissionsBefore;
+        opStats.allocations += t_allocations - allocationsBefore;
+
+        if (record.device())
+            record << op.join('\t') << '\n';
+
+        // Як простій UI між подіями: тут виконується відкладене стиснення журналу.
+        // Міряється окремим рядком "events", бо теж блокує UI потік
+        const quint64 eventAllocationsBefore = t_allocations;
+        QElapsedTimer eventTimer;
+        eventTimer.start();
+        QCoreApplication::processEvents();
+
+        OpStats &eventStats = stats["events"];
+        eventStats.latenciesNs.append(eventTimer.nsecsElapsed());
+        eventStats.allocations += t_allocations - eventAllocationsBefore;
+    }
+
+    const qint64 wallMs = clock.elapsed();
+    const qint64 sizeAfter = databaseSize(dbPath);
+
+    out << Qt::endl;
+    out << qSetFieldWidth(12) << Qt::left << "операція" << Qt::right
+        << "к-сть" << "p50 мс" << "p90 мс" << "p99 мс" << "max мс" << "сигн/оп" << "алок/оп"
+        << qSetFieldWidth(0) << Qt::endl;
+
+    for (auto it = stats.begin(); it != stats.end(); ++it) {
+        QList<qint64> sorted = it.value().latenciesNs;
+        std::sort(sorted.begin(), sorted.end());
+        const double count = sorted.size();
+
+        out << qSetFieldWidth(12) << Qt::left << it.key() << Qt::right
+            << sorted.size()
+            << QString::number(percentileMs(sorted, 0.50), 'f', 3)
+            << QString::number(percentileMs(sorted, 0.90), 'f', 3)
+            << QString::number(percentileMs(sorted, 0.99), 'f', 3)
+            << QString::number(sorted.last() / 1e6, 'f', 3)
+            << QString::number(it.value().emissions / count, 'f', 2)
+            << QString::number(it.value().allocations / count, 'f', 0)
+            << qSetFieldWidth(0) << Qt::endl;
+    }
+
+    out << Qt::endl;
+    out << "Операцій: " << totalOps << " за " << wallMs << " мс" << Qt::endl;
+    out << "coursesChanged усього: " << emissions << Qt::endl;
+    out << "алок/оп — лише алокації UI потоку; робота пулу читання у statistics не враховується" << Qt::endl;
+    out << "events — обробка подій між операціями (зокрема стиснення журналу)" << Qt::endl;
+    out << "Розмір БД (з WAL): " << sizeBefore << " -> " << sizeAfter
+        << " байт (+" << (sizeAfter - sizeBefore) << ")" << Qt::endl;
+
+    // Масштабування звіту: медіана з 20 прогонів на кожну кількість потоків
+    if (parser.isSet("scale")) {
+        QList<int> threadCounts;
+        for (int threads = 1; threads < QThread::idealThreadCount(); threads *= 2)
+            threadCounts.append(threads);
+        threadCounts.append(QThread::idealThreadCount());
+
+        out << Qt::endl << "Статистика за кількістю потоків:" << Qt::endl;
+        for (int threads : std::as_const(threadCounts)) {
+            manager.setReadThreadCount(threads);
+            runStatistics(manager); // прогрів: з'єднання нових потоків
+
+            QList<qint64> samples;
+            for (int run = 0; run < 20; ++run) {
+                QElapsedTimer timer;
+                timer.start();
+                runStatistics(manager);
+                samples.append(timer.nsecsElapsed());
+            }
+            std::sort(samples.begin(), samples.end());
+
+            out << qSetFieldWidth(12) << threads
+                << QString::number(percentileMs(samples, 0.50), 'f', 3)
+                << qSetFieldWidth(0) << " мс" << Qt::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include "workloadservice.h"
+#include <QDate>
+#include <QDebug>
+#include <limits>
+
+namespace {
+// Найдовший діапазон для dailyLoad/weeklyLoad (~4 роки): вивід щільний
+const qint64 kMaxRangeDays = 4 * 366;
+}
+
+WorkloadService::WorkloadService(DatabaseManager *dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(dbManager)
+{
+}
+
+void WorkloadService::reload()
+{
+    m_days.clear();
+
+    const QList<QVariantMap> buckets = m_dbManager->getOpenWorkload(0, std::numeric_limits<qint64>::max());
+
+    for (const QVariantMap &bucket : buckets) {
+        const int count = bucket["count"].toInt();
+        Bucket &day = m_days[bucket["due_day"].toLongLong()];
+        day.count += count;
+        day.weight += count * taskWeight(bucket["max_grade"].toString());
+    }
+
+    m_dirty = false;
+    emit workloadChanged();
+}
+
+void WorkloadService::addOpenTask(const QString &date, const QString &maxGrade)
+{
+    const qint64 day = DatabaseManager::dueDayFromDate(date);
+    if (day < 0)
+        return;
+
+    adjust(day, 1, taskWeight(maxGrade));
+}
+
+void WorkloadService::removeOpenTask(const QString &date, const QString &maxGrade)
+{
+    const qint64 day = DatabaseManager::dueDayFromDate(date);
+    if (day < 0)
+        return;
+
+    adjust(day, -1, -taskWeight(maxGrade));
+}
+
+double WorkloadService::taskWeight(const QString &maxGrade)
+{
+    bool ok = false;
+    const double value = maxGrade.trimmed().toDouble(&ok);
+    return ok && value > 0 ? value : 1.0;
+}
+
+void WorkloadService::adjust(qint64 day, int count, double weight)
+{
+    Bucket &bucket = m_days[day];
+    bucket.count += count;
+    bucket.weight += weight;
+
+    if (bucket.count <= 0) {
+        m_days.remove(day);
+    }
+
+    m_dirty = true;
+}
+
+void WorkloadService::flushChanges()
+{
+    // Один сигнал на мутацію, а не на кожне завдання (напр. відновлення курсу)
+    if (m_dirty) {
+        m_dirty = false;
+        emit workloadChanged();
+    }
+}
+
+QVariantList WorkloadService::dailyLoad(const QString &fromDate, const QString &toDate, bool weighted) const
+{
+    QVariantList result;
+    const qint64 from = DatabaseManager::dueDayFromDate(fromDate);
+    const qint64 to = DatabaseManager::dueDayFromDate(toDate);
+
+    if (from < 0 || to < from) {
+        qDebug() << "Невірний діапазон навантаження:" << fromDate << toDate;
+        return result;
+    }
+
+    if (to - from >= kMaxRangeDays) {
+        qDebug() << "Завеликий діапазон навантаження:" << fromDate << toDate;
+        return result;
+    }
+
+    auto it = m_days.lowerBound(from);
+
+    for (qint64 day = from; day <= to; ++day) {
+        Bucket bucket;
+        if (it != m_days.cend() && it.key() == day) {
+            bucket = it.value();
+            ++it;
+        }
+
+        QVariantMap entry;
+        entry["date"] = QDate::fromJulianDay(day).toString("dd.MM.yyyy");
+        entry["count"] = bucket.count;
+        entry["weight"] = bucket.weight;
+        entry["value"] = weighted ? bucket.weight : double(bucket.count);
+        result.append(entry);
+    }
+
+    return result;
+}
+
+QVariantList WorkloadService::weeklyLoad(const QString &fromDate, const QString &toDate, bool weighted) const
+{
+    QVariantList result;
+    qint64 from = DatabaseManager::dueDayFromDate(fromDate);
+    qint64 to = DatabaseManager::dueDayFromDate(toDate);
+
+    if (from < 0 || to < from) {
+        qDebug() << "Невірний діапазон навантаження:" << fromDate << toDate;
+        return result;
+    }
+
+    if (to - from >= kMaxRangeDays) {
+        qDebug() << "Завеликий діапазон навантаження:" << fromDate << toDate;
+        return result;
+    }
+
+    // Цілі тижні з понеділка по неділю, щоб кожен стовпчик мав 7 днів
+    from -= QDate::fromJulianDay(from).dayOfWeek() - 1;
+    to += 7 - QDate::fromJulianDay(to).dayOfWeek();
+    auto it = m_days.lowerBound(from);
+
+    for (qint64 weekStart = from; weekStart <= to; weekStart += 7) {
+        const qint64 weekEnd = weekStart + 6;
+        Bucket bucket;
+
+        while (it != m_days.cend() && it.key() <= weekEnd) {
+            bucket.count += it.value().count;
+            bucket.weight += it.value().weight;
+            ++it;
+        }
+
+        QVariantMap entry;
+        entry["week_start"] = QDate::fromJulianDay(weekStart).toString("dd.MM.yyyy");
+        entry["count"] = bucket.count;
+        entry["weight"] = bucket.weight;
+        entry["value"] = weighted ? bucket.weight : double(bucket.count);
+        result.append(entry);
+    }
+
+    return result;
+}
@@ -0,0 +1,52 @@
+#ifndef WORKLOADSERVICE_H
+#define WORKLOADSERVICE_H
+
+#include <QObject>
+#include <QMap>
+#include <QVariantList>
+#include "databasemanager.h"
+
+// Щільність дедлайнів по днях і тижнях для відкритих завдань
+class WorkloadService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WorkloadService(DatabaseManager *dbManager, QObject *parent = nullptr);
+
+    // Повне перезавантаження з БД (агрегація по due_day)
+    void reload();
+
+    // Інкрементне оновлення: відкрите завдання з'явилось / зникло.
+    // Сигнал не надсилається — після всієї мутації треба викликати flushChanges()
+    void addOpenTask(const QString &date, const QString &maxGrade);
+    void removeOpenTask(const QString &date, const QString &maxGrade);
+    void flushChanges();
+
+    // Вага завдання — max_grade, або 1 якщо не задано
+    static double taskWeight(const QString &maxGrade);
+
+    // Дати у форматі дд.мм.рррр, межі включно; повертає кожен день/тиждень діапазону.
+    // weeklyLoad розширює діапазон до цілих тижнів (пн–нд), тому крайні тижні
+    // можуть включати дні поза fromDate/toDate.
+    // Діапазони довші за ~4 роки відхиляються (порожній список)
+    Q_INVOKABLE QVariantList dailyLoad(const QString &fromDate, const QString &toDate, bool weighted = false) const;
+    Q_INVOKABLE QVariantList weeklyLoad(const QString &fromDate, const QString &toDate, bool weighted = false) const;
+
+signals:
+    void workloadChanged();
+
+private:
+    struct Bucket {
+        int count = 0;
+        double weight = 0.0;
+    };
+
+    DatabaseManager *m_dbManager;
+    QMap<qint64, Bucket> m_days;
+    bool m_dirty = false;
+
+    void adjust(qint64 day, int count, double weight);
+};
+
+#endif // WORKLOADSERVICE_H